@@ -0,0 +1,465 @@
+#include "content_catalog.h"
+#include <print>
+#include <fstream>
+#include <mutex>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <nlohmann/json.hpp>
+
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr std::uint64_t FNV_PRIME = 1099511628211ULL;
+constexpr int WATCH_POLL_TIMEOUT_MS = 500;
+constexpr size_t WATCH_EVENT_BUFFER = 1 << 16;
+
+// ---------- Helper Functions ----------
+
+bool ContentCatalog::is_catalog_candidate(const std::filesystem::directory_entry &entry) {
+    // Hidden files cover the index itself and its temporary during a save.
+    std::error_code ec;
+    return entry.is_regular_file(ec) && !entry.path().filename().string().starts_with('.');
+}
+
+bool ContentCatalog::stat_file(const std::filesystem::path &path, ContentEntry &entry) {
+    struct stat st {};
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    entry.size = static_cast<std::uintmax_t>(st.st_size);
+    entry.mtime_ns = st.st_mtim.tv_sec * 1'000'000'000LL + st.st_mtim.tv_nsec;
+    entry.ctime_ns = st.st_ctim.tv_sec * 1'000'000'000LL + st.st_ctim.tv_nsec;
+    entry.inode = static_cast<std::uint64_t>(st.st_ino);
+    return true;
+}
+
+bool ContentCatalog::same_file_state(const ContentEntry &a, const ContentEntry &b) {
+    // Size and mtime alone miss timestamp-preserving replacements (cp -p,
+    // rsync -t, tar x); the inode and ctime still change in those cases.
+    return a.size == b.size
+           && a.mtime_ns == b.mtime_ns
+           && a.ctime_ns == b.ctime_ns
+           && a.inode == b.inode;
+}
+
+std::uint64_t ContentCatalog::hash_file(const std::filesystem::path &path,
+                                        std::uintmax_t expected_size) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Could not read file: " + path.string());
+
+    std::vector<char> buffer(HASH_READ_BUFFER);
+    std::uint64_t hash = FNV_OFFSET_BASIS;
+    std::uintmax_t total_read = 0;
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        std::streamsize bytes_read = file.gcount();
+        total_read += static_cast<std::uintmax_t>(bytes_read);
+        for (std::streamsize i = 0; i < bytes_read; ++i) {
+            hash ^= static_cast<unsigned char>(buffer[i]);
+            hash *= FNV_PRIME;
+        }
+    }
+
+    // A read error or a file resized under us would otherwise be indexed
+    // with a hash of partial contents.
+    if (file.bad() || !file.eof())
+        throw std::runtime_error("Read error while hashing: " + path.string());
+    if (total_read != expected_size)
+        throw std::runtime_error("File changed size while hashing: " + path.string());
+    return hash;
+}
+
+std::unordered_map<std::string, ContentEntry> ContentCatalog::load_index() const {
+    std::unordered_map<std::string, ContentEntry> indexed;
+    std::ifstream file(index_path);
+    if (!file.is_open())
+        return indexed;
+
+    // A stale or corrupt index only costs a full rescan, never a failed start.
+    try {
+        nlohmann::json index_data = nlohmann::json::parse(file);
+        if (index_data["version"].get<int>() != CONTENT_INDEX_VERSION)
+            return indexed;
+
+        for (const auto &entry_data : index_data["entries"]) {
+            ContentEntry entry;
+            entry.name = entry_data["name"].get<std::string>();
+            entry.size = entry_data["size"].get<std::uintmax_t>();
+            entry.mtime_ns = entry_data["mtime_ns"].get<std::int64_t>();
+            entry.ctime_ns = entry_data["ctime_ns"].get<std::int64_t>();
+            entry.inode = entry_data["inode"].get<std::uint64_t>();
+            entry.hash = entry_data["hash"].get<std::uint64_t>();
+            indexed[entry.name] = entry;
+        }
+
+        // Racily clean entries, as in git: a file changed in the same
+        // timestamp tick as it was hashed keeps its stat fields, so any entry
+        // not strictly older than the index itself is re-hashed.
+        struct stat index_st {};
+        if (stat(index_path.c_str(), &index_st) == 0) {
+            std::int64_t index_mtime_ns = index_st.st_mtim.tv_sec * 1'000'000'000LL
+                                          + index_st.st_mtim.tv_nsec;
+            std::erase_if(indexed, [&](const auto &item) {
+                return item.second.mtime_ns >= index_mtime_ns
+                       || item.second.ctime_ns >= index_mtime_ns;
+            });
+        }
+    } catch (const nlohmann::json::exception &ex) {
+        std::print("[Catalog] Ignoring unreadable index: {}\n", ex.what());
+        indexed.clear();
+    }
+    return indexed;
+}
+
+void ContentCatalog::save_index() const {
+    nlohmann::json index_data;
+    index_data["version"] = CONTENT_INDEX_VERSION;
+    index_data["entries"] = nlohmann::json::array();
+    {
+        std::shared_lock lock(entries_lock);
+        for (const auto &[name, entry] : entries) {
+            index_data["entries"].push_back({
+                {"name", entry.name},
+                {"size", entry.size},
+                {"mtime_ns", entry.mtime_ns},
+                {"ctime_ns", entry.ctime_ns},
+                {"inode", entry.inode},
+                {"hash", entry.hash},
+            });
+        }
+    }
+
+    // Write beside the index, flush it to disk, then rename over the old
+    // one; a failed or interrupted save leaves the previous index intact.
+    std::filesystem::path tmp_path = index_path;
+    tmp_path += ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream file(tmp_path, std::ios::trunc);
+        if (file.is_open()) {
+            file << index_data.dump();
+            file.close();
+        }
+        if (!file.good()) {
+            std::print("[Catalog] Could not write index: {}\n", tmp_path.string());
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+    }
+
+    int fd = open(tmp_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::print("[Catalog] Could not reopen index for fsync: {}: {}\n",
+                   tmp_path.string(), std::strerror(errno));
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+    if (fsync(fd) != 0) {
+        std::print("[Catalog] Could not fsync index: {}: {}\n",
+                   tmp_path.string(), std::strerror(errno));
+        close(fd);
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+    close(fd);
+
+    std::filesystem::rename(tmp_path, index_path, ec);
+    if (ec) {
+        std::print("[Catalog] Could not replace index: {}\n", ec.message());
+        std::filesystem::remove(tmp_path, ec);
+        return;
+    }
+
+    // Persist the rename itself.
+    int dir_fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+}
+
+void ContentCatalog::scan() {
+    std::unordered_map<std::string, ContentEntry> indexed = load_index();
+    std::unordered_map<std::string, ContentEntry> scanned;
+    std::vector<ContentEntry*> to_hash;
+
+    // Files can vanish between listing and stat; skip them like failed hashes.
+    std::error_code ec;
+    std::filesystem::directory_iterator dir_it(directory, ec);
+    if (ec) {
+        std::print("[Catalog] Could not list {}: {}\n", directory.string(), ec.message());
+        return;
+    }
+    for (; dir_it != std::filesystem::directory_iterator(); dir_it.increment(ec)) {
+        const auto &dir_entry = *dir_it;
+        if (!is_catalog_candidate(dir_entry))
+            continue;
+
+        ContentEntry entry;
+        entry.name = dir_entry.path().filename().string();
+        if (!stat_file(dir_entry.path(), entry)) {
+            std::print("[Catalog] Skipping unreadable file: {}\n", entry.name);
+            continue;
+        }
+
+        auto it = indexed.find(entry.name);
+        bool unchanged = it != indexed.end() && same_file_state(it->second, entry);
+        if (unchanged)
+            entry.hash = it->second.hash;
+
+        auto [pos, inserted] = scanned.emplace(entry.name, entry);
+        if (!unchanged)
+            to_hash.push_back(&pos->second);
+    }
+    if (ec) {
+        // A partial listing would drop live files; keep what we had.
+        std::print("[Catalog] Directory listing interrupted: {}\n", ec.message());
+        return;
+    }
+
+    // Hash new and changed files across all cores; pointers into `scanned`
+    // stay valid since no insertions happen past this point.
+    std::vector<std::string> failed;
+    std::mutex failed_lock;
+    std::atomic<size_t> next = 0;
+    size_t num_workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                          to_hash.size());
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < to_hash.size(); i = next++) {
+                try {
+                    to_hash[i]->hash = hash_file(directory / to_hash[i]->name, to_hash[i]->size);
+                } catch (const std::exception &) {
+                    std::scoped_lock lock(failed_lock);
+                    failed.push_back(to_hash[i]->name);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    for (const auto &name : failed) {
+        std::print("[Catalog] Skipping unreadable file: {}\n", name);
+        scanned.erase(name);
+    }
+
+    hashed_last_scan = to_hash.size() - failed.size();
+    bool dirty = !to_hash.empty() || scanned.size() != indexed.size();
+    std::print("[Catalog] {} files catalogued ({} hashed, {} from index)\n",
+               scanned.size(), hashed_last_scan.load(),
+               scanned.size() - hashed_last_scan);
+    {
+        std::unique_lock lock(entries_lock);
+        entries = std::move(scanned);
+    }
+    if (dirty)
+        save_index();
+}
+
+// refresh_file/remove_file only touch memory and report whether anything
+// changed; the watcher persists the index once per batch of events.
+// Without force_hash the file is only re-hashed if its stat fields moved.
+bool ContentCatalog::refresh_file(const std::string &name, bool force_hash) {
+    std::filesystem::path path = directory / name;
+    ContentEntry entry;
+    entry.name = name;
+    try {
+        if (!stat_file(path, entry))
+            return remove_file(name);
+        if (!force_hash) {
+            std::optional<ContentEntry> current = lookup(name);
+            if (current && same_file_state(*current, entry))
+                return false;
+        }
+        entry.hash = hash_file(path, entry.size);
+    } catch (const std::exception &) {
+        // Gone, unreadable or still being written; the next event re-adds it.
+        return remove_file(name);
+    }
+    {
+        std::unique_lock lock(entries_lock);
+        entries[name] = entry;
+    }
+    std::print("[Catalog] Updated: {} ({} bytes)\n", name, entry.size);
+    return true;
+}
+
+bool ContentCatalog::remove_file(const std::string &name) {
+    {
+        std::unique_lock lock(entries_lock);
+        if (entries.erase(name) == 0)
+            return false;
+    }
+    std::print("[Catalog] Removed: {}\n", name);
+    return true;
+}
+
+void ContentCatalog::watch() {
+    alignas(inotify_event) char buffer[WATCH_EVENT_BUFFER];
+    pollfd pfd{inotify_fd, POLLIN, 0};
+
+    while (!stop_watching) {
+        if (poll(&pfd, 1, WATCH_POLL_TIMEOUT_MS) <= 0)
+            continue;
+
+        bool changed = false;
+        bool overflowed = false;
+        bool directory_gone = false;
+
+        // Drain everything queued first, keeping only the strongest pending
+        // action per file, so a bulk copy costs one hash per file and one
+        // index write.
+        enum class Pending { Restat, Rehash, Remove };
+        std::unordered_map<std::string, Pending> pending;
+        ssize_t len;
+        while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < len;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    overflowed = true;
+                    continue;
+                }
+                if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                    directory_gone = true;
+                    continue;
+                }
+                if (event->len == 0 || (event->mask & IN_ISDIR))
+                    continue;
+                std::string name(event->name);
+                if (name.starts_with('.'))
+                    continue;
+
+                if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    pending[name] = Pending::Remove;
+                } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    pending[name] = Pending::Rehash;
+                } else if (event->mask & (IN_CREATE | IN_ATTRIB | IN_MODIFY)) {
+                    // Hard links, truncate(2) and writers still holding the
+                    // file open never raise IN_CLOSE_WRITE here.
+                    auto [it, inserted] = pending.emplace(name, Pending::Restat);
+                    if (!inserted && it->second == Pending::Remove)
+                        it->second = Pending::Restat;
+                }
+            }
+        }
+
+        if (!overflowed && !directory_gone) {
+            for (const auto &[name, action] : pending) {
+                if (action == Pending::Remove)
+                    changed |= remove_file(name);
+                else
+                    changed |= refresh_file(name, action == Pending::Rehash);
+            }
+        }
+
+        if (directory_gone) {
+            std::print("[Catalog] {} was moved or deleted, no longer serving from it\n",
+                       directory.string());
+            std::unique_lock lock(entries_lock);
+            entries.clear();
+            break;
+        }
+        if (overflowed) {
+            // Events were lost; the incremental scan rebuilds from disk and saves.
+            std::print("[Catalog] inotify queue overflowed, rescanning {}\n", directory.string());
+            scan();
+        } else if (changed) {
+            save_index();
+        }
+    }
+}
+
+bool ContentCatalog::open_watch() {
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        perror("inotify_init1 failed");
+        return false;
+    }
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM
+                    | IN_CREATE | IN_ATTRIB | IN_MODIFY
+                    | IN_DELETE_SELF | IN_MOVE_SELF;
+    if (inotify_add_watch(inotify_fd, directory.c_str(), mask) < 0) {
+        perror("inotify_add_watch failed");
+        close(inotify_fd);
+        inotify_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+// ---------- Constructor ----------
+
+ContentCatalog::ContentCatalog(const std::filesystem::path &directory_path) {
+    directory = directory_path.empty() ? std::filesystem::path(".") : directory_path;
+    if (!std::filesystem::is_directory(directory))
+        throw std::invalid_argument("Content directory not found: " + directory.string());
+
+    index_path = directory / CONTENT_INDEX_FILENAME;
+
+    // Events raised while scanning stay queued on the fd until the watcher
+    // thread drains them; replaying them after the scan is harmless.
+    if (!open_watch())
+        std::print("[Catalog] Watching disabled for {}\n", directory.string());
+    scan();
+}
+
+// ---------- Destructor ----------
+
+ContentCatalog::~ContentCatalog() {
+    stop_watching = true;
+    if (watcher_thread.joinable())
+        watcher_thread.join();
+    if (inotify_fd >= 0)
+        close(inotify_fd);
+}
+
+// ---------- Public Methods ----------
+
+void ContentCatalog::start_watching() {
+    if (watcher_thread.joinable() || inotify_fd < 0)
+        return;
+    watcher_thread = std::thread(&ContentCatalog::watch, this);
+}
+
+bool ContentCatalog::contains(const std::string &name) const {
+    std::shared_lock lock(entries_lock);
+    return entries.contains(name);
+}
+
+std::optional<ContentEntry> ContentCatalog::lookup(const std::string &name) const {
+    std::shared_lock lock(entries_lock);
+    auto it = entries.find(name);
+    if (it == entries.end())
+        return std::nullopt;
+    return it->second;
+}
+
+std::vector<std::string> ContentCatalog::file_names() const {
+    std::vector<std::string> names;
+    {
+        std::shared_lock lock(entries_lock);
+        names.reserve(entries.size());
+        for (const auto &[name, entry] : entries)
+            names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+size_t ContentCatalog::size() const {
+    std::shared_lock lock(entries_lock);
+    return entries.size();
+}
+
+size_t ContentCatalog::last_scan_hashed() const { return hashed_last_scan; }
@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+
+constexpr const char* CONTENT_INDEX_FILENAME = ".content_index.json";
+constexpr int CONTENT_INDEX_VERSION = 2;
+constexpr size_t HASH_READ_BUFFER = 1 << 16;
+
+struct ContentEntry {
+    std::string name;
+    std::uintmax_t size{};
+    std::int64_t mtime_ns{};
+    std::int64_t ctime_ns{};
+    std::uint64_t inode{};
+    std::uint64_t hash{};   // FNV-1a 64 over the file contents
+};
+
+// Catalog of the files a node serves from its directory.
+// Built at startup from the persisted index (only new or changed files are
+// re-hashed, in parallel), then kept current through inotify. The watch is
+// added before the initial scan so nothing changed during it is missed.
+class ContentCatalog {
+private:
+    std::filesystem::path directory;
+    std::filesystem::path index_path;
+    std::unordered_map<std::string, ContentEntry> entries;
+    mutable std::shared_mutex entries_lock;
+
+    int inotify_fd = -1;
+    std::thread watcher_thread;
+    std::atomic<bool> stop_watching = false;
+    std::atomic<size_t> hashed_last_scan = 0;
+
+    // private helpers
+    static bool is_catalog_candidate(const std::filesystem::directory_entry &entry);
+    static bool stat_file(const std::filesystem::path &path, ContentEntry &entry);
+    static bool same_file_state(const ContentEntry &a, const ContentEntry &b);
+    static std::uint64_t hash_file(const std::filesystem::path &path, std::uintmax_t expected_size);
+    std::unordered_map<std::string, ContentEntry> load_index() const;
+    void save_index() const;
+    void scan();
+    bool refresh_file(const std::string &name, bool force_hash);
+    bool remove_file(const std::string &name);
+    bool open_watch();
+    void watch();
+
+public:
+    explicit ContentCatalog(const std::filesystem::path &directory_path);
+    ~ContentCatalog();
+
+    void start_watching();
+
+    bool contains(const std::string &name) const;
+    std::optional<ContentEntry> lookup(const std::string &name) const;
+    std::vector<std::string> file_names() const;
+    size_t size() const;
+    size_t last_scan_hashed() const;
+};
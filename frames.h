@@ -6,6 +6,8 @@
 
 constexpr int PAYLOAD_BUFFER = 4096;
 constexpr int TX_WINDOW_SIZE = 50;
+// payload_size of the single end frame sent when a request is refused
+constexpr int REJECT_PAYLOAD_SIZE = -1;
 
 
 struct PeerInfo{
@@ -110,6 +110,11 @@ void ClientUtils::start_rx_data_as_client(const int &rx_socket,
             last_ack_sent = ack.ack_num;
             std::print("[Client] Received frame {}, sent CACK {}\n",
                        rx_frame.sequence_number, ack.ack_num);
+
+            if (rx_frame.payload_size == REJECT_PAYLOAD_SIZE) {
+                std::print("[Client] Server does not serve '{}', nothing written\n", filename);
+                return;
+            }
         } else {
             std::print("[Client] Out-of-order frame {} (expected {}), resending CACK {}\n",
                        rx_frame.sequence_number, expected_seq, last_ack_sent);
@@ -270,3 +275,14 @@ void ServerUtils::send_data(std::vector<Dataframe> &frames,
     }
     std::print("[Server] Completed sending {} frames successfully!\n", seq_num_max);
 }
+
+void ServerUtils::send_rejection(int mySocket,
+                                 sockaddr_in &clientAddr,
+                                 std::mutex &socket_lock) {
+    // A single acknowledged end frame, so the client stops waiting for data.
+    std::vector<Dataframe> frames(1);
+    frames[0].sequence_number = 0;
+    frames[0].payload_size = REJECT_PAYLOAD_SIZE;
+    frames[0].end = true;
+    send_data(frames, mySocket, clientAddr, socket_lock);
+}
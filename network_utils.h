@@ -30,4 +30,7 @@ struct ServerUtils {
                           int mySocket,
                           sockaddr_in &clientAddr,
                           std::mutex &socket_lock);
+    static void send_rejection(int mySocket,
+                               sockaddr_in &clientAddr,
+                               std::mutex &socket_lock);
 };
@@ -4,6 +4,7 @@
 #include <thread>
 #include <chrono>
 #include <fstream>
+#include <algorithm>
 #include <stdexcept>
 #include <arpa/inet.h>
 #include <sys/socket.h>
@@ -65,6 +66,21 @@ int Node::find_file_in_nodes(const std::string &file) {
     throw std::runtime_error("Could not find file in nodes");
 }
 
+void Node::validate_content_info() {
+    for (const std::string &file : content_info) {
+        if (!get_node_content_metadata(file))
+            std::print("Warning: '{}' is listed in content_info but missing from {}\n",
+                       file, node_path.parent_path().string());
+    }
+}
+
+// Only advertised files are served; the catalog also holds the node's own
+// config and scripts, which peers must not be able to fetch.
+bool Node::serves_file(const std::string &file) const {
+    return std::ranges::find(content_info, file) != content_info.end()
+           && get_node_content_metadata(file).has_value();
+}
+
 // ---------- Constructor ----------
 
 Node::Node(const std::string &node_filepath_str) {
@@ -92,6 +108,10 @@ Node::Node(const std::string &node_filepath_str) {
         peer_info.push_back(peer);
     }
 
+    catalog = std::make_unique<ContentCatalog>(node_path.parent_path());
+    validate_content_info();
+    catalog->start_watching();
+
     if (!create_and_bind_socket())
         throw std::runtime_error("Socket binding error");
 }
@@ -112,6 +132,9 @@ std::string Node::get_node_hostname() const { return hostname; }
 std::string Node::get_node_path_str() const { return node_path.string(); }
 std::vector<std::string> Node::get_node_content_info() const { return content_info; }
 std::vector<PeerInfo> Node::get_node_peer_info() const { return peer_info; }
+std::optional<ContentEntry> Node::get_node_content_metadata(const std::string &file) const {
+    return catalog->lookup(file);
+}
 
 // ---------- Thread Methods ----------
 
@@ -175,6 +198,11 @@ void Node::start_as_server() {
                 } else {
                     std::print("Received {}\n", msg);
                     if (connections_table[clientPort] == ThreeWayHandshakeMessages::ESTABLISHED) {
+                        if (!serves_file(msg)) {
+                            std::print("Requested file not served here: {}\n", msg);
+                            ServerUtils::send_rejection(mySocket, clientAddr, socket_lock);
+                            continue;
+                        }
                         std::filesystem::path filepath = msg;
                         std::filesystem::path directory_path = node_path.parent_path();
                         std::filesystem::path requested_filepath = directory_path / filepath;
@@ -225,7 +253,12 @@ void Node::run() {
     std::print("Peers: {}\n", num_peers);
 
     std::print("Content info:\n");
-    for (const auto &c : content_info) std::print(" - {}\n", c);
+    for (const auto &c : content_info) {
+        if (auto entry = get_node_content_metadata(c))
+            std::print(" - {} ({} bytes, hash {:016x})\n", c, entry->size, entry->hash);
+        else
+            std::print(" - {} (missing)\n", c);
+    }
 
     std::print("Peer info:\n");
     for (size_t i = 0; i < peer_info.size(); ++i) {
@@ -4,11 +4,14 @@
 #include <queue>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <optional>
 #include <filesystem>
 #include <unordered_map>
 #include <netinet/in.h>
 #include "frames.h"
 #include "network_utils.h"
+#include "content_catalog.h"
 #include <nlohmann/json.hpp>
 
 class Node {
@@ -17,6 +20,7 @@ private:
     std::string hostname;
     std::vector<std::string> content_info;
     std::vector<PeerInfo> peer_info;
+    std::unique_ptr<ContentCatalog> catalog;
 
     std::queue<std::string> user_inputs;
     std::mutex user_input_queue_lock;
@@ -37,6 +41,8 @@ private:
     nlohmann::json parse_json(const std::filesystem::path &path);
     bool create_and_bind_socket();
     int find_file_in_nodes(const std::string &file);
+    void validate_content_info();
+    bool serves_file(const std::string &file) const;
 
 public:
     explicit Node(const std::string &node_filepath_str);
@@ -48,6 +54,7 @@ public:
     std::string get_node_path_str() const;
     std::vector<std::string> get_node_content_info() const;
     std::vector<PeerInfo> get_node_peer_info() const;
+    std::optional<ContentEntry> get_node_content_metadata(const std::string &file) const;
 
     // threads
     void take_user_input();
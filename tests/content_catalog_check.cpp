@@ -0,0 +1,154 @@
+// Standalone check for ContentCatalog against a scratch directory.
+//
+// Build and run from the repository root (needs <print>, i.e. GCC 14+, and
+// nlohmann/json on the include path):
+//   g++ -std=c++23 -I. tests/content_catalog_check.cpp content_catalog.cpp -pthread -o content_catalog_check
+//   ./content_catalog_check
+//
+// Exits non-zero if any check fails.
+#include "content_catalog.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <unistd.h>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string &what) {
+    std::cout << (condition ? "[PASS] " : "[FAIL] ") << what << '\n';
+    if (!condition)
+        ++failures;
+}
+
+static void write_file(const fs::path &path, const std::string &contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+// Coarse-timestamp filesystems stamp everything within one tick alike; make
+// sure the next write lands in a later tick than the index.
+static void let_timestamps_advance() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+static bool wait_until(const std::function<bool()> &condition) {
+    for (int i = 0; i < 60; ++i) {
+        if (condition())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return condition();
+}
+
+int main() {
+    fs::path dir = fs::temp_directory_path() / ("content_catalog_check_" + std::to_string(getpid()));
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    fs::path index_path = dir / CONTENT_INDEX_FILENAME;
+
+    write_file(dir / "a.bin", std::string(200000, 'a'));
+    write_file(dir / "b.bin", "bbbbbbbb");
+    write_file(dir / "c.bin", "cccc");
+    let_timestamps_advance();
+
+    // Cold start hashes everything and persists the index.
+    std::uint64_t b_hash{};
+    {
+        ContentCatalog catalog(dir);
+        check(catalog.size() == 3, "cold start catalogues all files");
+        check(catalog.last_scan_hashed() == 3, "cold start hashes all files");
+        check(fs::exists(index_path), "index is written");
+        check(!catalog.contains(CONTENT_INDEX_FILENAME), "index is not catalogued");
+        b_hash = catalog.lookup("b.bin")->hash;
+    }
+    let_timestamps_advance();
+
+    // Warm start reuses every hash from the index.
+    {
+        ContentCatalog catalog(dir);
+        check(catalog.last_scan_hashed() == 0, "index hit skips re-hashing");
+        check(catalog.lookup("b.bin")->hash == b_hash, "hash is restored from the index");
+    }
+
+    // Same size and mtime but new contents, plus an added and a removed file.
+    auto b_mtime = fs::last_write_time(dir / "b.bin");
+    write_file(dir / "b.bin", "BBBBBBBB");
+    fs::last_write_time(dir / "b.bin", b_mtime);
+    write_file(dir / "d.bin", "dddd");
+    fs::remove(dir / "c.bin");
+    let_timestamps_advance();
+    {
+        ContentCatalog catalog(dir);
+        check(catalog.last_scan_hashed() == 2, "only changed and added files are re-hashed");
+        check(catalog.lookup("b.bin")->hash != b_hash, "timestamp-preserving rewrite is detected");
+        check(catalog.contains("d.bin"), "added file is detected on restart");
+        check(!catalog.contains("c.bin"), "removed file is detected on restart");
+    }
+
+    // A corrupt or outdated index falls back to a full rescan.
+    write_file(index_path, "{ not json");
+    {
+        ContentCatalog catalog(dir);
+        check(catalog.last_scan_hashed() == 3, "corrupt index triggers a full rescan");
+    }
+    write_file(index_path, "{\"version\": 0, \"entries\": []}");
+    {
+        ContentCatalog catalog(dir);
+        check(catalog.last_scan_hashed() == 3, "wrong index version triggers a full rescan");
+    }
+
+    // inotify applies creates, moves and deletes, and keeps the index current.
+    {
+        ContentCatalog catalog(dir);
+        catalog.start_watching();
+        write_file(dir / "e.bin", "eeee");
+        fs::rename(dir / "a.bin", dir / "f.bin");
+        fs::remove(dir / "d.bin");
+
+        check(wait_until([&] { return catalog.contains("e.bin"); }), "watcher applies create");
+        check(wait_until([&] { return catalog.contains("f.bin") && !catalog.contains("a.bin"); }),
+              "watcher applies move");
+        check(wait_until([&] { return !catalog.contains("d.bin"); }), "watcher applies delete");
+
+        fs::create_hard_link(dir / "e.bin", dir / "link.bin");
+        check(wait_until([&] { return catalog.contains("link.bin"); }), "watcher applies hard link");
+        fs::resize_file(dir / "e.bin", 2);
+        check(wait_until([&] { return catalog.lookup("e.bin")->size == 2; }), "watcher applies truncate");
+        fs::remove(dir / "link.bin");
+        check(wait_until([&] { return !catalog.contains("link.bin"); }), "watcher applies unlink");
+    }
+    {
+        // Compare names only: unlinking link.bin also bumps e.bin's ctime,
+        // which inotify reports under the removed name.
+        std::ifstream index_file(index_path);
+        nlohmann::json index_data = nlohmann::json::parse(index_file);
+        std::vector<std::string> indexed_names;
+        for (const auto &entry : index_data["entries"])
+            indexed_names.push_back(entry["name"].get<std::string>());
+        std::sort(indexed_names.begin(), indexed_names.end());
+        check(indexed_names == std::vector<std::string>{"b.bin", "e.bin", "f.bin"},
+              "watcher changes are persisted to the index");
+
+        ContentCatalog catalog(dir);
+        check(catalog.file_names() == indexed_names, "restart after watching sees the same files");
+    }
+
+    // Entries not strictly older than the index are racily clean and re-hashed.
+    // b.bin kept its original mtime, so backdating the index to it makes all
+    // three entries racy.
+    fs::last_write_time(index_path, fs::last_write_time(dir / "b.bin"));
+    {
+        ContentCatalog catalog(dir);
+        check(catalog.last_scan_hashed() == 3, "racily clean entries are re-hashed");
+    }
+
+    fs::remove_all(dir);
+    std::cout << (failures == 0 ? "All checks passed\n" : "Some checks failed\n");
+    return failures == 0 ? 0 : 1;
+}